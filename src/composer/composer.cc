@@ -33,6 +33,7 @@
 
 #include "base/flags.h"
 #include "base/logging.h"
+#include "base/string_piece.h"
 #include "base/util.h"
 #include "composer/internal/composition.h"
 #include "composer/internal/composition_input.h"
@@ -711,7 +712,10 @@ void Composer::GetStringForPreedit(string *output) const {
   if (field_type == commands::Context::NUMBER ||
       field_type == commands::Context::PASSWORD ||
       field_type == commands::Context::TEL) {
-    const string tmp = *output;
+    // Swap instead of copy; FullWidthAsciiToHalfWidthAscii() cannot work
+    // in-place because the input and output buffers must not alias.
+    string tmp;
+    tmp.swap(*output);
     Util::FullWidthAsciiToHalfWidthAscii(tmp, output);
   }
 }
@@ -750,7 +754,8 @@ string *GetBaseQueryForPrediction(string *asis_query,
   // example, "ky" is the different part where asis_query is "もzky"
   // and trimed_query is "もz".
   DCHECK_GT(asis_query->size(), trimed_query->size());
-  const string asis_tail(*asis_query, trimed_query->size());
+  const StringPiece asis_tail(asis_query->data() + trimed_query->size(),
+                              asis_query->size() - trimed_query->size());
   DCHECK(!asis_tail.empty());
 
   // If the different part is not an alphabet, asis_query is used.
@@ -775,9 +780,8 @@ string *GetBaseQueryForPrediction(string *asis_query,
   // We assume "もzk" is user's intentional query, but "もずk" is not.
   // So our results are:
   // ("もzk", "もz") => "もzk" and ("もずk", "もず") => "もず".
-  const string trimed_tail = Util::SubString(*trimed_query,
-                                             Util::CharsLen(*trimed_query) - 1,
-                                             string::npos);
+  const StringPiece trimed_tail =
+      Util::SubStringPiece(*trimed_query, Util::CharsLen(*trimed_query) - 1);
   DCHECK(!trimed_tail.empty());
   const Util::ScriptType trimed_tail_type = Util::GetScriptType(trimed_tail);
   if (trimed_tail_type == Util::ALPHABET) {
@@ -34,7 +34,9 @@
 #include <string>
 #include <vector>
 
+#include "base/hash.h"
 #include "base/logging.h"
+#include "base/mozc_hash_map.h"
 #include "base/number_util.h"
 #include "base/port.h"
 #include "base/util.h"
@@ -59,6 +61,59 @@ namespace {
 
 const size_t kErrorIndex = static_cast<size_t>(-1);
 
+// The maximum number of memoized CompletePOSIds() results.
+const size_t kCompletedPOSCacheSize = 4096;
+
+// Returns the cache key of CompletePOSIds() for (key, value).  '\t' never
+// appears in keys so the concatenation is unambiguous.
+uint64 GetCompletedPOSCacheKey(const string &key, const string &value) {
+  return Hash::Fingerprint(key + '\t' + value);
+}
+
+// Candidate lists below this size are scanned linearly; larger ones are
+// indexed by a hash map first.
+const size_t kCandidateLinearSearchMax = 16;
+
+// Segment type transition applied by FinishConversion().  SUBMITTED
+// segments are reverted to FIXED_VALUE; other types are kept as they are.
+// Indexed by Segment::SegmentType so the transition is a branchless lookup.
+const Segment::SegmentType kFinishSegmentTypeTransition[] = {
+    Segment::FREE,            // FREE
+    Segment::FIXED_BOUNDARY,  // FIXED_BOUNDARY
+    Segment::FIXED_VALUE,     // FIXED_VALUE
+    Segment::FIXED_VALUE,     // SUBMITTED
+    Segment::HISTORY,         // HISTORY
+};
+
+struct StringPieceFingerprintHash {
+  size_t operator()(StringPiece s) const {
+    return Hash::Fingerprint32(s);
+  }
+};
+
+// Returns the index of the candidate in |segment| whose value is |value|,
+// or -1 if there is no such candidate.  For the large expansions of
+// CompletePOSIds(), a one-pass hash map avoids O(N) string comparisons.
+int FindCandidateByValue(const Segment &segment, const string &value) {
+  const size_t candidates_size = segment.candidates_size();
+  if (candidates_size < kCandidateLinearSearchMax) {
+    for (size_t i = 0; i < candidates_size; ++i) {
+      if (segment.candidate(i).value == value) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+  mozc_hash_map<StringPiece, size_t, StringPieceFingerprintHash> index;
+  index.reserve(candidates_size);
+  for (size_t i = 0; i < candidates_size; ++i) {
+    // emplace() keeps the first (best) candidate on duplicated values.
+    index.emplace(segment.candidate(i).value, i);
+  }
+  const auto it = index.find(value);
+  return (it == index.end()) ? -1 : static_cast<int>(it->second);
+}
+
 size_t GetSegmentIndex(const Segments *segments,
                        size_t segment_index) {
   const size_t history_segments_size = segments->history_segments_size();
@@ -90,6 +145,9 @@ bool IsMobile(const ConversionRequest &request) {
 
 bool IsValidSegments(const ConversionRequest &request,
                      const Segments &segments) {
+  // The same for all segments, so evaluate it before the loop.
+  const bool is_mobile = IsMobile(request);
+
   // All segments should have candidate
   for (size_t i = 0; i < segments.segments_size(); ++i) {
     if (segments.segment(i).candidates_size() != 0) {
@@ -99,7 +157,7 @@ bool IsValidSegments(const ConversionRequest &request,
     // So it's ok if we have meta candidates even if we don't have candidates
     // TODO(team): we may remove mobile check if other platforms accept
     // meta candidate only segment
-    if (IsMobile(request) && segments.segment(i).meta_candidates_size() != 0) {
+    if (is_mobile && segments.segment(i).meta_candidates_size() != 0) {
       continue;
     }
     return false;
@@ -210,7 +268,10 @@ bool TryNormalizingKeyAsMathExpression(StringPiece s, string *key) {
 
 ConverterImpl::ConverterImpl() : pos_matcher_(NULL),
                                  immutable_converter_(NULL),
-                                 general_noun_id_(kuint16max) {
+                                 general_noun_id_(kuint16max),
+                                 pos_id_cache_(kCompletedPOSCacheSize),
+                                 pos_id_expand_size_cache_(
+                                     kCompletedPOSCacheSize) {
 }
 
 ConverterImpl::~ConverterImpl() {}
@@ -319,23 +380,29 @@ bool ConverterImpl::StartReverseConversion(Segments *segments,
 // static
 void ConverterImpl::MaybeSetConsumedKeySizeToCandidate(
     size_t consumed_key_size, Segment::Candidate* candidate) {
-  if (candidate->attributes & Segment::Candidate::PARTIALLY_KEY_CONSUMED) {
-    // If PARTIALLY_KEY_CONSUMED is set already,
-    // the candidate has set appropriate attribute and size by predictor.
-    return;
-  }
+  // If PARTIALLY_KEY_CONSUMED is set already, the candidate has set
+  // appropriate attribute and size by predictor, so both fields must be
+  // kept.  Written with a mask instead of a branch: candidate lists mix
+  // both cases unpredictably, and this runs once per candidate.
+  const size_t already_consumed_mask =
+      -static_cast<size_t>((candidate->attributes &
+                            Segment::Candidate::PARTIALLY_KEY_CONSUMED) != 0);
   candidate->attributes |= Segment::Candidate::PARTIALLY_KEY_CONSUMED;
-  candidate->consumed_key_size = consumed_key_size;
+  candidate->consumed_key_size =
+      (candidate->consumed_key_size & already_consumed_mask) |
+      (consumed_key_size & ~already_consumed_mask);
 }
 
 // static
 void ConverterImpl::MaybeSetConsumedKeySizeToSegment(size_t consumed_key_size,
                                                      Segment* segment) {
-  for (size_t i = 0; i < segment->candidates_size(); ++i) {
+  const size_t candidates_size = segment->candidates_size();
+  for (size_t i = 0; i < candidates_size; ++i) {
     MaybeSetConsumedKeySizeToCandidate(consumed_key_size,
                                        segment->mutable_candidate(i));
   }
-  for (size_t i = 0; i < segment->meta_candidates_size(); ++i) {
+  const size_t meta_candidates_size = segment->meta_candidates_size();
+  for (size_t i = 0; i < meta_candidates_size; ++i) {
     MaybeSetConsumedKeySizeToCandidate(consumed_key_size,
                                        segment->mutable_meta_candidate(i));
   }
@@ -372,15 +439,20 @@ bool ConverterImpl::Predict(const ConversionRequest &request,
     // the results, we will reset always for suggestion request type.
     SetKey(segments, key);
   }
+  // Resolve the conversion segment once; the pointer stays valid across
+  // the prediction calls below, which never resize the segment list.
   DCHECK_EQ(1, segments->conversion_segments_size());
-  DCHECK_EQ(key, segments->conversion_segment(0).key());
+  Segment *conversion_segment = segments->mutable_conversion_segment(0);
+  DCHECK_EQ(key, conversion_segment->key());
+
+  const bool is_partial = (request_type == Segments::PARTIAL_SUGGESTION ||
+                           request_type == Segments::PARTIAL_PREDICTION);
 
   segments->set_request_type(request_type);
   predictor_->PredictForRequest(request, segments);
   RewriteAndSuppressCandidates(request, segments);
   TrimCandidates(request, segments);
-  if (request_type == Segments::PARTIAL_SUGGESTION ||
-      request_type == Segments::PARTIAL_PREDICTION) {
+  if (is_partial) {
     // Here 1st segment's key is the query string of
     // the partial prediction/suggestion.
     // e.g. If the composition is "わた|しは", the key is "わた".
@@ -391,8 +463,7 @@ bool ConverterImpl::Predict(const ConversionRequest &request,
     // should be set.
     // Note that this process should be done in a predictor because
     // we have to do this on the candidates created by rewriters.
-    MaybeSetConsumedKeySizeToSegment(
-        Util::CharsLen(key), segments->mutable_conversion_segment(0));
+    MaybeSetConsumedKeySizeToSegment(Util::CharsLen(key), conversion_segment);
   }
   return IsValidSegments(request, *segments);
 }
@@ -445,7 +516,10 @@ bool ConverterImpl::StartPartialSuggestionForRequest(
 
   string conversion_key;
   request.composer().GetQueryForConversion(&conversion_key);
-  conversion_key = Util::SubString(conversion_key, 0, cursor);
+  // Truncate in place; building the prefix with Util::SubString() would
+  // allocate a second string just to assign it back.
+  conversion_key.erase(
+      Util::SubStringPiece(conversion_key, 0, cursor).size());
   return Predict(request, conversion_key,
                  Segments::PARTIAL_SUGGESTION, segments);
 }
@@ -466,7 +540,10 @@ bool ConverterImpl::StartPartialPredictionForRequest(
 
   string conversion_key;
   request.composer().GetQueryForConversion(&conversion_key);
-  conversion_key = Util::SubString(conversion_key, 0, cursor);
+  // Truncate in place; building the prefix with Util::SubString() would
+  // allocate a second string just to assign it back.
+  conversion_key.erase(
+      Util::SubStringPiece(conversion_key, 0, cursor).size());
 
   return Predict(request, conversion_key,
                  Segments::PARTIAL_PREDICTION, segments);
@@ -484,10 +561,9 @@ bool ConverterImpl::FinishConversion(const ConversionRequest &request,
     // SUBMITTED segments are created by "submit first segment" operation
     // (ctrl+N for ATOK keymap).
     // To learn the conversion result, we should change the segment types
-    // to FIXED_VALUE.
-    if (seg->segment_type() == Segment::SUBMITTED) {
-      seg->set_segment_type(Segment::FIXED_VALUE);
-    }
+    // to FIXED_VALUE.  The table lookup keeps this pass branchless on
+    // mixed-type segments.
+    seg->set_segment_type(kFinishSegmentTypeTransition[seg->segment_type()]);
     if (seg->candidates_size() > 0) {
       CompletePOSIds(seg->mutable_candidate(0));
     }
@@ -498,13 +574,12 @@ bool ConverterImpl::FinishConversion(const ConversionRequest &request,
   predictor_->Finish(request, segments);
 
   // Remove the front segments except for some segments which will be
-  // used as history segments.
+  // used as history segments.  One batch erase_segments() call avoids
+  // shifting the remaining segments once per removed segment.
   const int start_index =
       std::max(0, static_cast<int>(segments->segments_size() -
                                    segments->max_history_segments_size()));
-  for (int i = 0; i < start_index; ++i) {
-    segments->pop_front_segment();
-  }
+  segments->erase_segments(0, start_index);
 
   // Remaining segments are used as history segments.
   for (size_t i = 0; i < segments->segments_size(); ++i) {
@@ -567,8 +642,14 @@ bool ConverterImpl::CommitSegmentValueInternal(
   if (segment_index == kErrorIndex) {
     return false;
   }
+  return CommitSegmentValueRaw(segments, segment_index, candidate_index,
+                               segment_type);
+}
 
-  Segment *segment = segments->mutable_segment(segment_index);
+bool ConverterImpl::CommitSegmentValueRaw(
+    Segments *segments, size_t raw_segment_index, int candidate_index,
+    Segment::SegmentType segment_type) const {
+  Segment *segment = segments->mutable_segment(raw_segment_index);
   const int values_size = static_cast<int>(segment->candidates_size());
   if (candidate_index < -transliteration::NUM_T13N_TYPES ||
       candidate_index >= values_size) {
@@ -596,9 +677,12 @@ bool ConverterImpl::CommitPartialSuggestionSegmentValue(
     const string &current_segment_key, const string &new_segment_key) const {
   DCHECK_GT(segments->conversion_segments_size(), 0);
 
+  // The raw index is resolved once here and reused below;
+  // CommitSegmentValueRaw() skips the redundant re-resolution.
   const size_t raw_segment_index = GetSegmentIndex(segments, segment_index);
-  if (!CommitSegmentValueInternal(segments, segment_index, candidate_index,
-                                  Segment::SUBMITTED)) {
+  if (raw_segment_index == kErrorIndex ||
+      !CommitSegmentValueRaw(segments, raw_segment_index, candidate_index,
+                             Segment::SUBMITTED)) {
     return false;
   }
   CommitUsageStats(segments, raw_segment_index, 1);
@@ -799,7 +883,15 @@ bool ConverterImpl::ResizeSegment(Segments *segments,
     return false;
   }
 
+  // Size the concatenation buffer first so the append loop doesn't
+  // reallocate |key| as it grows.
+  size_t total_key_bytes = 0;
+  for (size_t i = start_segment_index; i < end_segment_index; ++i) {
+    total_key_bytes += segments->segment(i).key().size();
+  }
+
   string key;
+  key.reserve(total_key_bytes);
   for (size_t i = start_segment_index; i < end_segment_index; ++i) {
     key += segments->segment(i).key();
   }
@@ -808,19 +900,32 @@ bool ConverterImpl::ResizeSegment(Segments *segments,
     return false;
   }
 
+  // Records the byte offset of every code point boundary in one pass so
+  // that the substring extraction below becomes a byte-range copy instead
+  // of rescanning |key| from its head for every new segment.
+  std::vector<size_t> boundaries;
+  boundaries.reserve(key.size() + 1);
+  for (size_t offset = 0; offset < key.size();
+       offset += Util::OneCharLen(key.data() + offset)) {
+    boundaries.push_back(offset);
+  }
+  boundaries.push_back(key.size());
+
   size_t consumed = 0;
-  const size_t key_len = Util::CharsLen(key);
+  const size_t key_len = boundaries.size() - 1;
   std::vector<string> new_keys;
   new_keys.reserve(array_size + 1);
 
   for (size_t i = 0; i < array_size; ++i) {
     if (new_size_array[i] != 0 && consumed < key_len) {
-      new_keys.push_back(Util::SubString(key, consumed, new_size_array[i]));
+      const size_t end = std::min(key_len, consumed + new_size_array[i]);
+      new_keys.push_back(key.substr(boundaries[consumed],
+                                    boundaries[end] - boundaries[consumed]));
       consumed += new_size_array[i];
     }
   }
   if (consumed < key_len) {
-    new_keys.push_back(Util::SubString(key, consumed, key_len - consumed));
+    new_keys.push_back(key.substr(boundaries[consumed]));
   }
 
   segments->erase_segments(start_segment_index, segments_size);
@@ -849,6 +954,23 @@ void ConverterImpl::CompletePOSIds(Segment::Candidate *candidate) const {
     return;
   }
 
+  // Users tend to commit the same words repeatedly, so the result of the
+  // expensive expansion below is memoized per (key, value).
+  const uint64 cache_key =
+      GetCompletedPOSCacheKey(candidate->key, candidate->value);
+  {
+    scoped_lock lock(&pos_id_cache_mutex_);
+    const CompletedPOSInfo *info = pos_id_cache_.Lookup(cache_key);
+    if (info != NULL) {
+      candidate->lid = info->lid;
+      candidate->rid = info->rid;
+      candidate->cost = info->cost;
+      candidate->wcost = info->wcost;
+      candidate->structure_cost = info->structure_cost;
+      return;
+    }
+  }
+
   // Use general noun,  unknown word ("サ変") tend to produce
   // "する" "して", which are not always acceptable for non-sahen words.
   candidate->lid = general_noun_id_;
@@ -860,9 +982,27 @@ void ConverterImpl::CompletePOSIds(Segment::Candidate *candidate) const {
   // In order to reduce the latency, first, expand 5 candidates.
   // If no valid candidates are found within 5 candidates, expand
   // candidates step-by-step.
-  for (size_t size = kExpandSizeStart; size < kExpandSizeMax;
+  // If this key needed a larger expansion size last time, start from that
+  // size directly instead of repeating the smaller, failing expansions.
+  const uint64 expand_cache_key = Hash::Fingerprint(candidate->key);
+  size_t start_size = kExpandSizeStart;
+  {
+    scoped_lock lock(&pos_id_cache_mutex_);
+    const size_t *cached_size =
+        pos_id_expand_size_cache_.Lookup(expand_cache_key);
+    if (cached_size != NULL && *cached_size < kExpandSizeMax) {
+      start_size = *cached_size;
+    }
+  }
+  // |segments| and |default_request| are reused over the expansion loop to
+  // avoid re-allocating internal buffers and re-constructing the request on
+  // every iteration.  Convert() is just a proxy which builds a default
+  // ConversionRequest per call, so call ConvertForRequest() directly.
+  Segments segments;
+  const ConversionRequest default_request;
+  for (size_t size = start_size; size < kExpandSizeMax;
        size += kExpandSizeDiff) {
-    Segments segments;
+    segments.Clear();
     SetKey(&segments, candidate->key);
     // use PREDICTION mode, as the size of segments after
     // PREDICTION mode is always 1, thanks to real time conversion.
@@ -872,23 +1012,34 @@ void ConverterImpl::CompletePOSIds(Segment::Candidate *candidate) const {
     segments.set_request_type(Segments::PREDICTION);
     segments.set_max_prediction_candidates_size(size);
     // In order to complete POSIds, call ImmutableConverter again.
-    if (!immutable_converter_->Convert(&segments)) {
+    if (!immutable_converter_->ConvertForRequest(default_request, &segments)) {
       LOG(ERROR) << "ImmutableConverter::Convert() failed";
       return;
     }
-    for (size_t i = 0; i < segments.segment(0).candidates_size(); ++i) {
+    const int found_index =
+        FindCandidateByValue(segments.segment(0), candidate->value);
+    if (found_index >= 0) {
       const Segment::Candidate &ref_candidate =
-          segments.segment(0).candidate(i);
-      if (ref_candidate.value == candidate->value) {
-        candidate->lid = ref_candidate.lid;
-        candidate->rid = ref_candidate.rid;
-        candidate->cost = ref_candidate.cost;
-        candidate->wcost = ref_candidate.wcost;
-        candidate->structure_cost = ref_candidate.structure_cost;
-        VLOG(1) << "Set LID: " << candidate->lid;
-        VLOG(1) << "Set RID: " << candidate->rid;
-        return;
+          segments.segment(0).candidate(found_index);
+      candidate->lid = ref_candidate.lid;
+      candidate->rid = ref_candidate.rid;
+      candidate->cost = ref_candidate.cost;
+      candidate->wcost = ref_candidate.wcost;
+      candidate->structure_cost = ref_candidate.structure_cost;
+      VLOG(1) << "Set LID: " << candidate->lid;
+      VLOG(1) << "Set RID: " << candidate->rid;
+      CompletedPOSInfo info;
+      info.lid = candidate->lid;
+      info.rid = candidate->rid;
+      info.cost = candidate->cost;
+      info.wcost = candidate->wcost;
+      info.structure_cost = candidate->structure_cost;
+      {
+        scoped_lock lock(&pos_id_cache_mutex_);
+        pos_id_cache_.Insert(cache_key, info);
+        pos_id_expand_size_cache_.Insert(expand_cache_key, size);
       }
+      return;
     }
   }
   DVLOG(2) << "Cannot set lid/rid. use default value. "
@@ -912,16 +1063,22 @@ void ConverterImpl::RewriteAndSuppressCandidates(
   // layer, there's possibility that bad words are generated from multiple nodes
   // and by rewriters. Hence, we need to apply it again at the last stage of
   // converter.
-  for (size_t i = 0; i < segments->conversion_segments_size(); ++i) {
+  const size_t conversion_segments_size = segments->conversion_segments_size();
+  for (size_t i = 0; i < conversion_segments_size; ++i) {
     Segment *seg = segments->mutable_conversion_segment(i);
-    for (size_t j = 0; j < seg->candidates_size(); ) {
+    // Collect the indices first and erase them in one batch;
+    // erase_candidate() shifts the trailing candidates on every call.
+    std::vector<size_t> suppressed_indices;
+    const size_t candidates_size = seg->candidates_size();
+    for (size_t j = 0; j < candidates_size; ++j) {
       const Segment::Candidate &cand = seg->candidate(j);
       if (suppression_dictionary_->SuppressEntry(cand.key, cand.value)) {
-        seg->erase_candidate(j);
-      } else {
-        ++j;
+        suppressed_indices.push_back(j);
       }
     }
+    if (!suppressed_indices.empty()) {
+      seg->erase_candidates_at(suppressed_indices);
+    }
   }
 }
 
@@ -933,8 +1090,9 @@ void ConverterImpl::TrimCandidates(const ConversionRequest &request,
   }
 
   const int limit = request_proto.candidates_size_limit();
+  const size_t conversion_segments_size = segments->conversion_segments_size();
   for (size_t segment_index = 0;
-       segment_index < segments->conversion_segments_size(); ++segment_index) {
+       segment_index < conversion_segments_size; ++segment_index) {
     Segment *seg = segments->mutable_conversion_segment(segment_index);
     const int candidates_size = seg->candidates_size();
     // A segment should have at least one candidate.
@@ -961,14 +1119,19 @@ void ConverterImpl::CommitUsageStats(const Segments *segments,
 
   // Timing stats are scaled by 1,000 to improve the accuracy of average values.
 
+  // The lengths are computed in one pass first so that all the timing
+  // updates can be committed with a single stats store below.
+  std::vector<uint32> submitted_lengths_x1000;
+  submitted_lengths_x1000.reserve(segment_length);
   uint64 submitted_total_length = 0;
   for (size_t i = 0; i < segment_length; ++i) {
     const Segment &segment = segments->segment(begin_segment_index + i);
     const uint32 submitted_length = Util::CharsLen(segment.candidate(0).value);
-    UsageStats::UpdateTiming("SubmittedSegmentLengthx1000",
-                             submitted_length * 1000);
+    submitted_lengths_x1000.push_back(submitted_length * 1000);
     submitted_total_length += submitted_length;
   }
+  UsageStats::UpdateTimingBatch("SubmittedSegmentLengthx1000",
+                                submitted_lengths_x1000);
 
   UsageStats::UpdateTiming("SubmittedLengthx1000",
                            submitted_total_length * 1000);
@@ -33,9 +33,11 @@
 #include <memory>
 #include <string>
 
+#include "base/mutex.h"
 #include "converter/converter_interface.h"
 #include "dictionary/pos_matcher.h"
 #include "dictionary/suppression_dictionary.h"
+#include "storage/lru_cache.h"
 //  for FRIEND_TEST()
 #include "testing/base/public/gunit_prod.h"
 
@@ -123,6 +125,15 @@ class ConverterImpl : public ConverterInterface {
                              size_t array_size) const;
 
  private:
+  // Cached result of CompletePOSIds() for a (key, value) pair.
+  struct CompletedPOSInfo {
+    uint16 lid;
+    uint16 rid;
+    int32 cost;
+    int32 wcost;
+    int32 structure_cost;
+  };
+
   FRIEND_TEST(ConverterTest, CompletePOSIds);
   FRIEND_TEST(ConverterTest, DefaultPredictor);
   FRIEND_TEST(ConverterTest, MaybeSetConsumedKeySizeToSegment);
@@ -140,6 +151,14 @@ class ConverterImpl : public ConverterInterface {
                                   int candidate_index,
                                   Segment::SegmentType segment_type) const;
 
+  // Same as CommitSegmentValueInternal() but takes a segment index which
+  // is already resolved by GetSegmentIndex().  Use this when the caller
+  // needs the raw index anyway, to avoid resolving it twice.
+  bool CommitSegmentValueRaw(Segments *segments,
+                             size_t raw_segment_index,
+                             int candidate_index,
+                             Segment::SegmentType segment_type) const;
+
   // Sets all the candidates' attribute PARTIALLY_KEY_CONSUMED
   // and consumed_key_size if the attribute is not set.
   static void MaybeSetConsumedKeySizeToCandidate(size_t consumed_key_size,
@@ -179,6 +198,20 @@ class ConverterImpl : public ConverterInterface {
   std::unique_ptr<RewriterInterface> rewriter_;
   const ImmutableConverterInterface *immutable_converter_;
   uint16 general_noun_id_;
+
+  // Memoizes results of CompletePOSIds(), which otherwise runs the
+  // immutable converter for every unset candidate.  Since users tend to
+  // commit the same words repeatedly, this cache skips most of the
+  // conversions on the commit path.  Guarded by |pos_id_cache_mutex_|
+  // because ConverterImpl is shared by all sessions.
+  mutable storage::LRUCache<uint64, CompletedPOSInfo> pos_id_cache_;
+
+  // Remembers, per key, the expansion size with which CompletePOSIds()
+  // found the committed value last time.  Keys which historically needed
+  // more than the initial expansion size can then skip the smaller, always
+  // failing expansions.  Guarded by |pos_id_cache_mutex_| as well.
+  mutable storage::LRUCache<uint64, size_t> pos_id_expand_size_cache_;
+  mutable Mutex pos_id_cache_mutex_;
 };
 
 }  // namespace mozc
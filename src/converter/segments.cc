@@ -206,7 +206,10 @@ StringPiece Segment::Candidate::InnerSegmentIterator::GetContentValue() const {
 
 Segment::Segment()
     : segment_type_(FREE),
-      pool_(new ObjectPool<Candidate>(16)) {}
+      // 64 candidates per chunk: conversion segments routinely hold tens of
+      // candidates (up to kMaxConversionCandidatesSize), so 16-object chunks
+      // caused several slab allocations per segment expansion.
+      pool_(new ObjectPool<Candidate>(64)) {}
 
 Segment::~Segment() {}
 
@@ -349,6 +352,20 @@ void Segment::erase_candidates(int i, size_t size) {
                     candidates_.begin() + end);
 }
 
+void Segment::erase_candidates_at(const std::vector<size_t> &indices) {
+  size_t write = 0;
+  size_t next = 0;
+  for (size_t read = 0; read < candidates_.size(); ++read) {
+    if (next < indices.size() && indices[next] == read) {
+      pool_->Release(candidates_[read]);
+      ++next;
+      continue;
+    }
+    candidates_[write++] = candidates_[read];
+  }
+  candidates_.resize(write);
+}
+
 size_t Segment::meta_candidates_size() const {
   return meta_candidates_.size();
 }
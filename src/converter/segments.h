@@ -134,6 +134,11 @@ class Segment {
       USER_HISTORY_PREDICTOR = 1 << 6,
     };
 
+    // The fields below are laid out so that the data touched by the
+    // converter hot paths (key, value and the scalar fields) shares the
+    // candidate's leading cache lines; the rarely touched usage and
+    // description strings follow after them.
+
     string key;         // reading
     string value;       // surface form
     string content_key;
@@ -141,19 +146,6 @@ class Segment {
 
     size_t consumed_key_size;
 
-    // Meta information
-    string prefix;
-    string suffix;
-    // Description including description type and message
-    string description;
-
-    // Usage ID
-    int32 usage_id;
-    // Title of the usage containing basic form of this candidate.
-    string usage_title;
-    // Content of the usage.
-    string usage_description;
-
     // Context "sensitive" candidate cost.
     // Taking adjacent words/nodes into consideration.
     // Basically, canidate is sorted by this cost.
@@ -185,6 +177,19 @@ class Segment {
     // The style is defined in enum |Command|.
     Command command;
 
+    // Meta information
+    string prefix;
+    string suffix;
+    // Description including description type and message
+    string description;
+
+    // Usage ID
+    int32 usage_id;
+    // Title of the usage containing basic form of this candidate.
+    string usage_title;
+    // Content of the usage.
+    string usage_description;
+
     // Boundary information for realtime conversion.  This will be set only for
     // realtime conversion result candidates.  Each element is the encoded
     // lengths of key, value, content key and content value.
@@ -320,6 +325,11 @@ class Segment {
   void erase_candidate(int i);
   void erase_candidates(int i, size_t size);
 
+  // erase the candidates at |indices|, which must be sorted in ascending
+  // order.  Runs in O(candidates_size()) regardless of the number of
+  // erased candidates, unlike repeated erase_candidate() calls.
+  void erase_candidates_at(const std::vector<size_t> &indices);
+
   // erase all candidates
   // do not erase meta candidates
   void clear_candidates();
@@ -224,6 +224,36 @@ TEST(CandidateTest, BasicTest) {
   EXPECT_EQ(cand[1], segment.mutable_candidate(2));
 }
 
+TEST(CandidateTest, EraseCandidatesAt) {
+  Segment segment;
+
+  const int kCandidatesSize = 5;
+  Segment::Candidate *cand[kCandidatesSize];
+  for (int i = 0; i < kCandidatesSize; ++i) {
+    cand[i] = segment.push_back_candidate();
+  }
+
+  std::vector<size_t> indices;
+  indices.push_back(1);
+  indices.push_back(3);
+  segment.erase_candidates_at(indices);
+  EXPECT_EQ(3, segment.candidates_size());
+  EXPECT_EQ(cand[0], segment.mutable_candidate(0));
+  EXPECT_EQ(cand[2], segment.mutable_candidate(1));
+  EXPECT_EQ(cand[4], segment.mutable_candidate(2));
+
+  // An empty index list is a no-op.
+  segment.erase_candidates_at(std::vector<size_t>());
+  EXPECT_EQ(3, segment.candidates_size());
+
+  indices.clear();
+  indices.push_back(0);
+  indices.push_back(1);
+  indices.push_back(2);
+  segment.erase_candidates_at(indices);
+  EXPECT_EQ(0, segment.candidates_size());
+}
+
 TEST(CandidateTest, CopyFrom) {
   Segment::Candidate src, dest;
   src.Init();
@@ -30,9 +30,9 @@
 #ifndef MOZC_DICTIONARY_SUPPRESSION_DICTIONARY_H_
 #define MOZC_DICTIONARY_SUPPRESSION_DICTIONARY_H_
 
-#include <set>
 #include <string>
 
+#include "base/mozc_hash_set.h"
 #include "base/mutex.h"
 #include "base/port.h"
 
@@ -75,7 +75,9 @@ class SuppressionDictionary {
   bool SuppressEntry(const string &key, const string &value) const;
 
  private:
-  std::set<string> dic_;
+  // The entries are only inserted and looked up as a whole, so a hash set
+  // gives O(1) lookup in SuppressEntry(), which runs once per candidate.
+  mozc_hash_set<string> dic_;
   bool locked_;
   bool has_key_empty_;
   bool has_value_empty_;
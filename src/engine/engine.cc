@@ -33,6 +33,7 @@
 
 #include "base/logging.h"
 #include "base/port.h"
+#include "base/thread.h"
 #include "converter/connector.h"
 #include "converter/converter.h"
 #include "converter/converter_interface.h"
@@ -72,6 +73,32 @@ using mozc::dictionary::ValueDictionary;
 namespace mozc {
 namespace {
 
+// Runs a predictor user-data operation (Sync or Reload) on its own
+// thread so it can overlap with the corresponding rewriter operation.
+// Both operations are dominated by disk I/O on independent data.
+class PredictorUserDataThread final : public Thread {
+ public:
+  PredictorUserDataThread(PredictorInterface *predictor,
+                          bool (PredictorInterface::*method)())
+      : predictor_(predictor), method_(method), result_(false) {
+    SetJoinable(true);
+  }
+
+  void Run() override {
+    result_ = (predictor_->*method_)();
+  }
+
+  // Valid only after Join().
+  bool result() const { return result_; }
+
+ private:
+  PredictorInterface *predictor_;
+  bool (PredictorInterface::*method_)();
+  bool result_;
+
+  DISALLOW_COPY_AND_ASSIGN(PredictorUserDataThread);
+};
+
 class UserDataManagerImpl final : public UserDataManagerInterface {
  public:
   explicit UserDataManagerImpl(PredictorInterface *predictor,
@@ -98,15 +125,26 @@ class UserDataManagerImpl final : public UserDataManagerInterface {
 UserDataManagerImpl::~UserDataManagerImpl() {}
 
 bool UserDataManagerImpl::Sync() {
-  // TODO(noriyukit): In the current implementation, if rewriter_->Sync() fails,
-  // predictor_->Sync() is never called. Check if we should call
-  // predictor_->Sync() or not.
-  return rewriter_->Sync() && predictor_->Sync();
+  // The rewriter and the predictor sync independent data, so overlap the
+  // two disk-bound operations.  Note that this also runs the predictor
+  // sync even when the rewriter sync fails, unlike the previous
+  // short-circuiting version.
+  PredictorUserDataThread predictor_thread(predictor_,
+                                           &PredictorInterface::Sync);
+  predictor_thread.Start("PredictorSync");
+  const bool rewriter_result = rewriter_->Sync();
+  predictor_thread.Join();
+  return rewriter_result && predictor_thread.result();
 }
 
 bool UserDataManagerImpl::Reload() {
-  // TODO(noriyukit): The same TODO as Sync().
-  return rewriter_->Reload() && predictor_->Reload();
+  // See the comment in Sync() above.
+  PredictorUserDataThread predictor_thread(predictor_,
+                                           &PredictorInterface::Reload);
+  predictor_thread.Start("PredictorReload");
+  const bool rewriter_result = rewriter_->Reload();
+  predictor_thread.Join();
+  return rewriter_result && predictor_thread.result();
 }
 
 bool UserDataManagerImpl::ClearUserHistory() {
@@ -1159,8 +1159,23 @@ bool DictionaryPredictor::PushBackTopConversionResult(
     std::vector<Result> *results) const {
   DCHECK_EQ(1, segments.conversion_segments_size());
 
+  // StartConversionForRequest() replaces the conversion segments via
+  // SetKey(), so a full Segments::CopyFrom() would deep-copy candidates
+  // that are immediately thrown away.  Carry over only the history
+  // segments and the scalar settings.
   Segments tmp_segments;
-  tmp_segments.CopyFrom(segments);
+  tmp_segments.set_max_history_segments_size(
+      segments.max_history_segments_size());
+  tmp_segments.set_max_prediction_candidates_size(
+      segments.max_prediction_candidates_size());
+  tmp_segments.set_user_history_enabled(segments.user_history_enabled());
+  tmp_segments.set_request_type(segments.request_type());
+  if (segments.resized()) {
+    tmp_segments.set_resized(true);
+  }
+  for (size_t i = 0; i < segments.history_segments_size(); ++i) {
+    tmp_segments.add_segment()->CopyFrom(segments.history_segment(i));
+  }
   tmp_segments.set_max_conversion_candidates_size(20);
   ConversionRequest tmp_request;
   tmp_request.CopyFrom(request);
@@ -30,7 +30,6 @@
 #ifndef MOZC_PREDICTION_DICTIONARY_PREDICTOR_H_
 #define MOZC_PREDICTION_DICTIONARY_PREDICTOR_H_
 
-#include <functional>
 #include <string>
 #include <vector>
 
@@ -39,8 +39,8 @@ ConversionRequest::ConversionRequest()
     : composer_(NULL),
       request_(&commands::Request::default_instance()),
       config_(&config::ConfigHandler::DefaultConfig()),
-      use_actual_converter_for_realtime_conversion_(false),
       composer_key_selection_(CONVERSION_KEY),
+      use_actual_converter_for_realtime_conversion_(false),
       skip_slow_rewriters_(false),
       create_partial_candidates_(false) {}
 
@@ -50,8 +50,8 @@ ConversionRequest::ConversionRequest(const composer::Composer *c,
     : composer_(c),
       request_(request),
       config_(config),
-      use_actual_converter_for_realtime_conversion_(false),
       composer_key_selection_(CONVERSION_KEY),
+      use_actual_converter_for_realtime_conversion_(false),
       skip_slow_rewriters_(false),
       create_partial_candidates_(false) {}
 
@@ -124,6 +124,9 @@ void ConversionRequest::set_create_partial_candidates(bool value) {
 }
 
 bool ConversionRequest::IsKanaModifierInsensitiveConversion() const {
+  // Note: this cannot be cached at set_request()/set_config() time; callers
+  // mutate the pointed-to request and config in place after handing them to
+  // a ConversionRequest, so the fields must be re-read on every call.
   return request_->kana_modifier_insensitive_conversion() &&
          config_->use_kana_modifier_insensitive_conversion();
 }
@@ -132,9 +135,9 @@ void ConversionRequest::CopyFrom(const ConversionRequest &request) {
   composer_ = request.composer_;
   request_ = request.request_;
   config_ = request.config_;
+  composer_key_selection_ = request.composer_key_selection_;
   use_actual_converter_for_realtime_conversion_ =
       request.use_actual_converter_for_realtime_conversion_;
-  composer_key_selection_ = request.composer_key_selection_;
   skip_slow_rewriters_ = request.skip_slow_rewriters_;
   create_partial_candidates_ = request.create_partial_candidates_;
 }
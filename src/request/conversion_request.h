@@ -118,15 +118,18 @@ class ConversionRequest {
   // Input config.
   const config::Config *config_;
 
+  // Which composer's method to use for conversion key; see the comment around
+  // the definition of ComposerKeySelection above.
+  // Note: the enum is declared before the bool flags below so that the flags
+  // share its trailing padding; this keeps the object one word smaller, which
+  // matters a bit for DictionaryPredictor's temporary copies.
+  ComposerKeySelection composer_key_selection_;
+
   // If true, insert a top candidate from the actual (non-immutable) converter
   // to realtime conversion results. Note that setting this true causes a big
   // performance loss (3 times slower).
   bool use_actual_converter_for_realtime_conversion_;
 
-  // Which composer's method to use for conversion key; see the comment around
-  // the definition of ComposerKeySelection above.
-  ComposerKeySelection composer_key_selection_;
-
   // Don't use this flag directly. This flag is used by DictionaryPredictor to
   // skip some heavy rewriters, such as UserBoundaryHistoryRewriter and
   // TransliterationRewriter.
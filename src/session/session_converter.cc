@@ -568,9 +568,6 @@ bool SessionConverter::ExpandSuggestionWithPreferences(
   // Initialize the segments for prediction.
   SetConversionPreferences(preferences, segments_.get());
 
-  string preedit;
-  composer.GetQueryForPrediction(&preedit);
-
   // We do not need "segments_->clear_conversion_segments()".
   // Without this statement we can add additional candidates into
   // existing segments.
@@ -605,7 +602,10 @@ bool SessionConverter::ExpandSuggestionWithPreferences(
   // Without this logic, a candidate gets focused that is unexpected behavior.
   segments_->set_request_type(Segments::SUGGESTION);
 
-  // Merge suggestions and predictions.
+  // Merge suggestions and predictions.  The query is built here, after the
+  // prediction calls above, so the failure path does not pay for it.
+  string preedit;
+  composer.GetQueryForPrediction(&preedit);
   PrependCandidates(previous_suggestions_, preedit, segments_.get());
 
   segment_index_ = 0;
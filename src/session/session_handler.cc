@@ -260,6 +260,13 @@ void SessionHandler::SetConfig(const config::Config &config) {
   config::CharacterFormManager::GetCharacterFormManager()->ReloadConfig(config);
 }
 
+void SessionHandler::SetConfigIfChanged(const config::Config &config) {
+  if (config.SerializeAsString() == config_->SerializeAsString()) {
+    return;
+  }
+  SetConfig(config);
+}
+
 bool SessionHandler::SyncData(commands::Command *command) {
   VLOG(1) << "Syncing user data";
   engine_->GetUserDataManager()->Sync();
@@ -279,7 +286,7 @@ bool SessionHandler::Reload(commands::Command *command) {
   {
     config::Config config;
     config::ConfigHandler::GetConfig(&config);
-    SetConfig(config);
+    SetConfigIfChanged(config);
   }
   engine_->Reload();
   return true;
@@ -319,7 +326,7 @@ bool SessionHandler::GetStoredConfig(commands::Command *command) {
 
   // Ensure the onmemory config is same as the locally stored one
   // because the local data could be changed by sync.
-  SetConfig(command->output().config());
+  SetConfigIfChanged(command->output().config());
 
   return true;
 }
@@ -700,11 +707,20 @@ bool SessionHandler::CreateSession(commands::Command *command) {
   }
 
   // Ensure the onmemory config is same as the locally stored one
-  // because the local data could be changed by sync.
+  // because the local data could be changed by sync.  When the stored
+  // config is unchanged, the existing sessions are already up to date, so
+  // only the new session needs to be configured.
   {
     config::Config config;
     config::ConfigHandler::GetConfig(&config);
-    SetConfig(config);
+    if (config.SerializeAsString() != config_->SerializeAsString()) {
+      SetConfig(config);
+    } else {
+      session->SetConfig(config_.get());
+      session->SetRequest(request_.get());
+      session->SetTable(table_manager_->GetTable(
+          *request_, *config_, *engine_->GetDataManager()));
+    }
   }
 
   // session is not empty.
@@ -117,6 +117,10 @@ class SessionHandler : public SessionHandlerInterface {
   // Sets config to all the modules managed by this handler.  This does not
   // affect the stored config in the local storage.
   void SetConfig(const config::Config &config);
+  // Calls SetConfig() only when |config| differs from the config currently
+  // held by this handler.  Re-syncing the same config is a no-op, so this
+  // skips the table rebuild and the session-wide reconfiguration.
+  void SetConfigIfChanged(const config::Config &config);
   // Updates the stored config, if the |command| contains the config.
   void MaybeUpdateStoredConfig(commands::Command *command);
 
@@ -53,7 +53,13 @@ namespace ibus {
 namespace {
 
 // A key which associates an IBusProperty object with MozcEngineProperty.
-const char kGObjectDataKey[] = "ibus-mozc-aux-data";
+// The key is interned into a GQuark once so that every attach/lookup is an
+// integer-keyed g_object_*_qdata() call instead of a per-call string hash
+// inside g_object_*_data().
+GQuark GetGObjectDataQuark() {
+  static const GQuark quark = g_quark_from_static_string("ibus-mozc-aux-data");
+  return quark;
+}
 
 // Icon path for MozcTool
 const char kMozcToolIconPath[] = "tool.png";
@@ -178,7 +184,7 @@ void PropertyHandler::AppendCompositionPropertyToPanel() {
                                            TRUE /* visible */,
                                            state,
                                            NULL /* sub props */);
-    g_object_set_data(G_OBJECT(item), kGObjectDataKey, (gpointer)&entry);
+    g_object_set_qdata(G_OBJECT(item), GetGObjectDataQuark(), (gpointer)&entry);
     ibus_prop_list_append(sub_prop_list, item);
     // |sub_prop_list| owns |item| by calling g_object_ref_sink for the |item|.
   }
@@ -265,7 +271,7 @@ void PropertyHandler::AppendToolPropertyToPanel() {
                                            TRUE,
                                            PROP_STATE_UNCHECKED,
                                            NULL);
-    g_object_set_data(G_OBJECT(item), kGObjectDataKey, (gpointer)&entry);
+    g_object_set_qdata(G_OBJECT(item), GetGObjectDataQuark(), (gpointer)&entry);
     ibus_prop_list_append(sub_prop_list, item);
   }
 
@@ -404,7 +410,7 @@ void PropertyHandler::ProcessPropertyActivate(IBusEngine *engine,
       if (!g_strcmp0(property_name, ibus_property_get_key(prop))) {
         const MozcEngineToolProperty *entry =
             reinterpret_cast<const MozcEngineToolProperty*>(
-                g_object_get_data(G_OBJECT(prop), kGObjectDataKey));
+                g_object_get_qdata(G_OBJECT(prop), GetGObjectDataQuark()));
         DCHECK(entry->mode);
         if (!client_->LaunchTool(entry->mode, "")) {
           LOG(ERROR) << "cannot launch: " << entry->mode;
@@ -428,7 +434,7 @@ void PropertyHandler::ProcessPropertyActivate(IBusEngine *engine,
       if (!g_strcmp0(property_name, ibus_property_get_key(prop))) {
         const MozcEngineProperty *entry =
             reinterpret_cast<const MozcEngineProperty*>(
-                g_object_get_data(G_OBJECT(prop), kGObjectDataKey));
+                g_object_get_qdata(G_OBJECT(prop), GetGObjectDataQuark()));
         SetCompositionMode(engine, entry->composition_mode);
         UpdateCompositionModeIcon(
             engine, entry->composition_mode);
@@ -189,6 +189,37 @@ void UsageStats::UpdateTiming(const string &name, uint32 val) {
   SetterInternal(name, stats);
 }
 
+void UsageStats::UpdateTimingBatch(const string &name,
+                                   const std::vector<uint32> &values) {
+  DCHECK(IsListed(name)) << name << " is not in the list";
+  if (values.empty()) {
+    return;
+  }
+  if (!config::StatsConfigUtil::IsEnabled()) {
+    return;
+  }
+
+  Stats stats;
+  if (!GetterInternal(name, Stats::TIMING, &stats)) {
+    stats.set_name(name);
+    stats.set_type(Stats::TIMING);
+    stats.set_num_timings(0);
+    stats.set_total_time(0);
+    stats.set_min_time(values[0]);
+    stats.set_max_time(values[0]);
+  }
+  for (size_t i = 0; i < values.size(); ++i) {
+    const uint32 val = values[i];
+    stats.set_num_timings(stats.num_timings() + 1);
+    stats.set_total_time(stats.total_time() + val);
+    stats.set_min_time(std::min(stats.min_time(), val));
+    stats.set_max_time(std::max(stats.max_time(), val));
+  }
+  stats.set_avg_time(stats.total_time() / stats.num_timings());
+
+  SetterInternal(name, stats);
+}
+
 void UsageStats::SetInteger(const string &name, int val) {
   DCHECK(IsListed(name)) << name << " is not in the list";
   if (!config::StatsConfigUtil::IsEnabled()) {
@@ -53,6 +53,12 @@ class UsageStats {
   // Updates current value using given val
   static void UpdateTiming(const string &name, uint32 val);
 
+  // Updates timing value with all the values in |values| at once.
+  // Equivalent to calling UpdateTiming() once per value, but loads and
+  // stores the underlying stats entry only once.
+  static void UpdateTimingBatch(const string &name,
+                                const std::vector<uint32> &values);
+
   // Sets integer value
   // Replaces old value with val
   static void SetInteger(const string &name, int val);
@@ -208,6 +208,44 @@ void SetEventStats(
 }
 }  // namespace
 
+TEST_F(UsageStatsTest, UpdateTimingBatchTest) {
+  const char kTimingKey[] = "ElapsedTimeUSec";
+  uint64 total_time = 0;
+  uint32 num_timings = 0;
+  uint32 avg_time = 0;
+  uint32 min_time = 0;
+  uint32 max_time = 0;
+
+  // An empty batch must not register an entry.
+  UsageStats::UpdateTimingBatch(kTimingKey, std::vector<uint32>());
+  EXPECT_FALSE(UsageStats::GetTimingForTest(kTimingKey, &total_time,
+                   &num_timings, &avg_time, &min_time, &max_time));
+
+  std::vector<uint32> values;
+  values.push_back(5);
+  values.push_back(7);
+  UsageStats::UpdateTimingBatch(kTimingKey, values);
+  EXPECT_TRUE(UsageStats::GetTimingForTest(kTimingKey, &total_time,
+                  &num_timings, &avg_time, &min_time, &max_time));
+  EXPECT_EQ(12, total_time);
+  EXPECT_EQ(2, num_timings);
+  EXPECT_EQ(6, avg_time);
+  EXPECT_EQ(5, min_time);
+  EXPECT_EQ(7, max_time);
+
+  // A following batch accumulates into the existing entry.
+  values.clear();
+  values.push_back(9);
+  UsageStats::UpdateTimingBatch(kTimingKey, values);
+  EXPECT_TRUE(UsageStats::GetTimingForTest(kTimingKey, &total_time,
+                  &num_timings, &avg_time, &min_time, &max_time));
+  EXPECT_EQ(21, total_time);
+  EXPECT_EQ(3, num_timings);
+  EXPECT_EQ(7, avg_time);
+  EXPECT_EQ(5, min_time);
+  EXPECT_EQ(9, max_time);
+}
+
 TEST_F(UsageStatsTest, StoreTouchEventStats) {
   string stats_str;
   EXPECT_FALSE(storage::Registry::Lookup("usage_stats.VirtualKeyboardStats",